@@ -0,0 +1,290 @@
+/**************************************************************************
+ *   bvh.cpp  --  This file is part of OBJ2BIT.                           *
+ *                                                                        *
+ *   Copyright (C) 2017, Ivo Filot (ivo@ivofilot.nl)                      *
+ *                                                                        *
+ *   OBJ2BIT is free software:                                            *
+ *   you can redistribute it and/or modify it under the terms of the      *
+ *   GNU General Public License as published by the Free Software         *
+ *   Foundation, either version 3 of the License, or (at your option)     *
+ *   any later version.                                                   *
+ *                                                                        *
+ *   OBJ2BIT is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#include "bvh.h"
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+
+#include "parallel.h"
+
+BVH::BVH(const MeshBase* mesh, unsigned int nr_threads) {
+    const std::vector<glm::vec3>& vertices = mesh->get_vertices();
+    const std::vector<uint32_t>& indices = mesh->get_indices();
+    const uint32_t nr_triangles = indices.size() / 3;
+
+    if(nr_triangles == 0) {
+        throw std::runtime_error("Cannot build BVH for a mesh without triangles");
+    }
+
+    // calculate triangle centroids
+    std::vector<glm::vec3> centroids(nr_triangles);
+    parallel_for(nr_triangles, nr_threads, [&](unsigned int, size_t begin, size_t end) {
+        for(size_t i=begin; i<end; i++) {
+            centroids[i] = (vertices[indices[i*3]] + vertices[indices[i*3+1]] + vertices[indices[i*3+2]]) / 3.0f;
+        }
+    });
+
+    std::vector<uint32_t> order(nr_triangles);
+    std::iota(order.begin(), order.end(), 0);
+
+    // every level below the root doubles the number of concurrent builds
+    unsigned int parallel_depth = 0;
+    while((1u << parallel_depth) < get_nr_threads(nr_threads)) {
+        parallel_depth++;
+    }
+
+    this->nodes.reserve(2 * nr_triangles / leaf_size + 1);
+    this->build(order, centroids, vertices, indices, 0, nr_triangles, this->nodes, parallel_depth);
+
+    // store triangles in leaf order
+    this->triangles.resize(nr_triangles * 3);
+    parallel_for(nr_triangles, nr_threads, [&](unsigned int, size_t begin, size_t end) {
+        for(size_t i=begin; i<end; i++) {
+            for(unsigned int j=0; j<3; j++) {
+                this->triangles[i*3+j] = vertices[indices[order[i]*3+j]];
+            }
+        }
+    });
+}
+
+float BVH::closest_distance2(const glm::vec3& p, uint32_t* hint) const {
+    float best = std::numeric_limits<float>::infinity();
+    uint32_t best_triangle = 0;
+
+    // a nearby triangle gives a tight initial bound which prunes most nodes
+    if(hint != nullptr && *hint < this->get_nr_triangles()) {
+        best_triangle = *hint;
+        best = point_triangle_distance2(p, this->triangles[best_triangle*3],
+                                           this->triangles[best_triangle*3+1],
+                                           this->triangles[best_triangle*3+2]);
+    }
+
+    uint32_t stack[64];
+    unsigned int stack_size = 0;
+    stack[stack_size++] = 0;
+
+    while(stack_size > 0) {
+        const Node& node = this->nodes[stack[--stack_size]];
+        if(point_box_distance2(p, node) >= best) {
+            continue;
+        }
+
+        if(node.count > 0) {
+            for(uint32_t i=node.start; i<node.start + node.count; i++) {
+                const float d2 = point_triangle_distance2(p, this->triangles[i*3],
+                                                             this->triangles[i*3+1],
+                                                             this->triangles[i*3+2]);
+                if(d2 < best) {
+                    best = d2;
+                    best_triangle = i;
+                }
+            }
+        } else {
+            // push the nearest child last so that it is visited first
+            const uint32_t left = &node - &this->nodes[0] + 1;
+            const uint32_t right = node.start;
+            const float dl = point_box_distance2(p, this->nodes[left]);
+            const float dr = point_box_distance2(p, this->nodes[right]);
+
+            if(dl < dr) {
+                if(dr < best) stack[stack_size++] = right;
+                stack[stack_size++] = left;
+            } else {
+                if(dl < best) stack[stack_size++] = left;
+                stack[stack_size++] = right;
+            }
+        }
+    }
+
+    if(hint != nullptr) {
+        *hint = best_triangle;
+    }
+
+    return best;
+}
+
+void BVH::build(std::vector<uint32_t>& order,
+                const std::vector<glm::vec3>& centroids,
+                const std::vector<glm::vec3>& vertices,
+                const std::vector<uint32_t>& indices,
+                uint32_t first,
+                uint32_t count,
+                std::vector<Node>& out,
+                unsigned int parallel_depth) {
+
+    const uint32_t idx = out.size();
+    out.push_back(Node());
+
+    if(count <= leaf_size) {
+        glm::vec3 bmin(std::numeric_limits<float>::max());
+        glm::vec3 bmax(-std::numeric_limits<float>::max());
+        for(uint32_t i=first; i<first+count; i++) {
+            for(unsigned int j=0; j<3; j++) {
+                const glm::vec3& v = vertices[indices[order[i]*3+j]];
+                bmin = glm::min(bmin, v);
+                bmax = glm::max(bmax, v);
+            }
+        }
+        out[idx] = {bmin, bmax, first, count};
+        return;
+    }
+
+    // split at the median centroid along the longest axis
+    glm::vec3 cmin(std::numeric_limits<float>::max());
+    glm::vec3 cmax(-std::numeric_limits<float>::max());
+    for(uint32_t i=first; i<first+count; i++) {
+        cmin = glm::min(cmin, centroids[order[i]]);
+        cmax = glm::max(cmax, centroids[order[i]]);
+    }
+
+    const glm::vec3 extent = cmax - cmin;
+    unsigned int axis = 0;
+    if(extent[1] > extent[axis]) axis = 1;
+    if(extent[2] > extent[axis]) axis = 2;
+
+    const uint32_t half = count / 2;
+    std::nth_element(order.begin() + first, order.begin() + first + half, order.begin() + first + count,
+                     [&centroids, axis](uint32_t a, uint32_t b) {
+                         return centroids[a][axis] < centroids[b][axis];
+                     });
+
+    uint32_t right;
+    if(parallel_depth > 0) {
+        // build both halves into separate arrays and append them, shifting
+        // the child references of interior nodes to their new position
+        std::vector<Node> left_nodes;
+        std::vector<Node> right_nodes;
+
+        std::thread left_thread([&]() {
+            this->build(order, centroids, vertices, indices, first, half, left_nodes, parallel_depth - 1);
+        });
+        this->build(order, centroids, vertices, indices, first + half, count - half, right_nodes, parallel_depth - 1);
+        left_thread.join();
+
+        for(auto* subtree : {&left_nodes, &right_nodes}) {
+            const uint32_t offset = out.size();
+            for(Node node : *subtree) {
+                if(node.count == 0) {
+                    node.start += offset;
+                }
+                out.push_back(node);
+            }
+        }
+        right = idx + 1 + left_nodes.size();
+    } else {
+        this->build(order, centroids, vertices, indices, first, half, out, 0);
+        right = out.size();
+        this->build(order, centroids, vertices, indices, first + half, count - half, out, 0);
+    }
+
+    out[idx] = {glm::min(out[idx+1].bmin, out[right].bmin),
+                glm::max(out[idx+1].bmax, out[right].bmax),
+                right,
+                0};
+}
+
+/*
+ * Closest point on triangle following Ericson, Real-Time Collision
+ * Detection (2005), section 5.1.5
+ */
+float BVH::point_triangle_distance2(const glm::vec3& p,
+                                    const glm::vec3& a,
+                                    const glm::vec3& b,
+                                    const glm::vec3& c) {
+    const glm::vec3 ab = b - a;
+    const glm::vec3 ac = c - a;
+    const glm::vec3 ap = p - a;
+
+    // vertex region a
+    const float d1 = glm::dot(ab, ap);
+    const float d2 = glm::dot(ac, ap);
+    if(d1 <= 0.0f && d2 <= 0.0f) {
+        return glm::dot(ap, ap);
+    }
+
+    // vertex region b
+    const glm::vec3 bp = p - b;
+    const float d3 = glm::dot(ab, bp);
+    const float d4 = glm::dot(ac, bp);
+    if(d3 >= 0.0f && d4 <= d3) {
+        return glm::dot(bp, bp);
+    }
+
+    // edge region ab
+    const float vc = d1 * d4 - d3 * d2;
+    if(vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) {
+        const glm::vec3 q = a + ab * (d1 / (d1 - d3));
+        return glm::dot(p - q, p - q);
+    }
+
+    // vertex region c
+    const glm::vec3 cp = p - c;
+    const float d5 = glm::dot(ab, cp);
+    const float d6 = glm::dot(ac, cp);
+    if(d6 >= 0.0f && d5 <= d6) {
+        return glm::dot(cp, cp);
+    }
+
+    // edge region ac
+    const float vb = d5 * d2 - d1 * d6;
+    if(vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) {
+        const glm::vec3 q = a + ac * (d2 / (d2 - d6));
+        return glm::dot(p - q, p - q);
+    }
+
+    // edge region bc
+    const float va = d3 * d6 - d5 * d4;
+    if(va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f) {
+        const glm::vec3 q = b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+        return glm::dot(p - q, p - q);
+    }
+
+    // collinear vertices; the closest point lies on one of the edges
+    const float sum = va + vb + vc;
+    if(!(sum > 0.0f)) {
+        return std::min(point_segment_distance2(p, a, b),
+                        std::min(point_segment_distance2(p, b, c),
+                                 point_segment_distance2(p, a, c)));
+    }
+
+    // face region
+    const float denom = 1.0f / sum;
+    const glm::vec3 q = a + ab * (vb * denom) + ac * (vc * denom);
+    return glm::dot(p - q, p - q);
+}
+
+float BVH::point_segment_distance2(const glm::vec3& p,
+                                   const glm::vec3& a,
+                                   const glm::vec3& b) {
+    const glm::vec3 ab = b - a;
+    const float len2 = glm::dot(ab, ab);
+    const float t = len2 > 0.0f ? glm::clamp(glm::dot(p - a, ab) / len2, 0.0f, 1.0f) : 0.0f;
+    const glm::vec3 q = a + ab * t;
+    return glm::dot(p - q, p - q);
+}
+
+float BVH::point_box_distance2(const glm::vec3& p, const Node& node) {
+    const glm::vec3 d = glm::max(glm::max(node.bmin - p, p - node.bmax), glm::vec3(0.0f));
+    return glm::dot(d, d);
+}
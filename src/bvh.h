@@ -0,0 +1,90 @@
+/**************************************************************************
+ *   bvh.h  --  This file is part of OBJ2BIT.                             *
+ *                                                                        *
+ *   Copyright (C) 2017, Ivo Filot (ivo@ivofilot.nl)                      *
+ *                                                                        *
+ *   OBJ2BIT is free software:                                            *
+ *   you can redistribute it and/or modify it under the terms of the      *
+ *   GNU General Public License as published by the Free Software         *
+ *   Foundation, either version 3 of the License, or (at your option)     *
+ *   any later version.                                                   *
+ *                                                                        *
+ *   OBJ2BIT is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#ifndef _BVH_H
+#define _BVH_H
+
+#include <vector>
+#include <limits>
+
+#include "mesh_base.h"
+
+/*
+ * Bounding volume hierarchy over the triangles of a mesh, used for
+ * closest point queries. Nodes are stored depth-first: the left child of
+ * an interior node directly follows its parent. The triangle vertices are
+ * copied in leaf order so that a leaf is one contiguous block in memory.
+ */
+class BVH {
+private:
+    struct Node {
+        glm::vec3 bmin;
+        glm::vec3 bmax;
+        uint32_t start;     // first triangle (leaf) or right child (interior)
+        uint32_t count;     // number of triangles, zero for interior nodes
+    };
+
+    std::vector<Node> nodes;
+    std::vector<glm::vec3> triangles;   // three vertices per triangle
+
+    static const unsigned int leaf_size = 4;
+
+public:
+    /*
+     * Build the hierarchy; the top levels of the tree are built concurrently
+     * on nr_threads threads (0 = all hardware threads)
+     */
+    BVH(const MeshBase* mesh, unsigned int nr_threads = 0);
+
+    /*
+     * Return the squared distance from p to the closest point on the mesh.
+     * The triangle found is stored in hint; passing the result of a nearby
+     * earlier query as hint speeds up the search considerably.
+     */
+    float closest_distance2(const glm::vec3& p, uint32_t* hint = nullptr) const;
+
+    inline size_t get_nr_triangles() const {
+        return this->triangles.size() / 3;
+    }
+
+private:
+    void build(std::vector<uint32_t>& order,
+               const std::vector<glm::vec3>& centroids,
+               const std::vector<glm::vec3>& vertices,
+               const std::vector<uint32_t>& indices,
+               uint32_t first,
+               uint32_t count,
+               std::vector<Node>& out,
+               unsigned int parallel_depth);
+
+    static float point_triangle_distance2(const glm::vec3& p,
+                                          const glm::vec3& a,
+                                          const glm::vec3& b,
+                                          const glm::vec3& c);
+
+    static float point_segment_distance2(const glm::vec3& p,
+                                         const glm::vec3& a,
+                                         const glm::vec3& b);
+
+    static float point_box_distance2(const glm::vec3& p, const Node& node);
+};
+
+#endif //_BVH_H
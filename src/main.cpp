@@ -19,9 +19,25 @@
  *                                                                        *
  **************************************************************************/
 
+#include <cmath>
+
 #include <tclap/CmdLine.h>
 
 #include "mesh_parser.h"
+#include "mesh_watcher.h"
+#include "mesh_stats.h"
+
+static void print_statistics(const std::string& filename, const MeshStats::Statistics& stats) {
+    std::cout << "Statistics for: " << filename << std::endl;
+    std::cout << boost::format("  Triangles:            %i") % stats.nr_triangles << std::endl;
+    std::cout << boost::format("  Vertices:             %i (%i unique)") % stats.nr_vertices % stats.nr_unique_vertices << std::endl;
+    std::cout << boost::format("  Degenerate triangles: %i") % stats.nr_degenerate_triangles << std::endl;
+    std::cout << boost::format("  Duplicate triangles:  %i") % stats.nr_duplicate_triangles << std::endl;
+    std::cout << boost::format("  AABB min:             (%g, %g, %g)") % stats.aabb_min.x % stats.aabb_min.y % stats.aabb_min.z << std::endl;
+    std::cout << boost::format("  AABB max:             (%g, %g, %g)") % stats.aabb_max.x % stats.aabb_max.y % stats.aabb_max.z << std::endl;
+    std::cout << boost::format("  Surface area:         %g") % stats.surface_area << std::endl;
+    std::cout << boost::format("  Volume:               %g") % stats.volume << std::endl;
+}
 
 int main(int argc, char* argv[]) {
 
@@ -38,14 +54,83 @@ int main(int argc, char* argv[]) {
         //**************************************
 
         // input file
-        TCLAP::ValueArg<std::string> arg_input_filename("i","input","Input file (i.e. sphere.obj)",true,"__NONE__","filename");
+        TCLAP::ValueArg<std::string> arg_input_filename("i","input","Input file (i.e. sphere.obj) or directory in watch mode",true,"__NONE__","filename");
         cmd.add(arg_input_filename);
 
-        TCLAP::ValueArg<std::string> arg_output_filename("o","output","Output file (i.e. sphere.mesh)",true,"__NONE__","filename");
+        TCLAP::ValueArg<std::string> arg_output_filename("o","output","Output file (i.e. sphere.mesh) or directory in watch mode",false,"__NONE__","filename");
         cmd.add(arg_output_filename);
 
+        // watch mode
+        TCLAP::SwitchArg arg_watch("w","watch","Watch input directory and convert OBJ files on change", false);
+        cmd.add(arg_watch);
+
+        TCLAP::ValueArg<unsigned int> arg_debounce("d","debounce","Time in ms a file must be left untouched before conversion (watch mode)",false,250,"ms");
+        cmd.add(arg_debounce);
+
+        // mesh statistics and comparison
+        TCLAP::SwitchArg arg_stats("s","stats","Report statistics of the input mesh instead of converting it", false);
+        cmd.add(arg_stats);
+
+        TCLAP::ValueArg<std::string> arg_diff("c","diff","Compare the input mesh against this mesh (i.e. sphere_old.mesh)",false,"__NONE__","filename");
+        cmd.add(arg_diff);
+
+        TCLAP::ValueArg<double> arg_max_distance("x","max-distance","Fail when the Hausdorff distance of the comparison exceeds this value",false,-1.0,"distance");
+        cmd.add(arg_max_distance);
+
+        TCLAP::ValueArg<unsigned int> arg_threads("t","threads","Number of threads for statistics and comparison (0 = all)",false,0,"threads");
+        cmd.add(arg_threads);
+
         cmd.parse(argc, argv);
 
+        if(arg_stats.getValue() || arg_diff.isSet()) {
+            MeshParser mp;
+            MeshStats ms(arg_threads.getValue());
+
+            MeshBase* mesh = mp.read(arg_input_filename.getValue());
+            std::vector<uint32_t> welded;
+            print_statistics(arg_input_filename.getValue(), ms.calculate_statistics(mesh, &welded));
+
+            int result = 0;
+            if(arg_diff.isSet()) {
+                MeshBase* other = mp.read(arg_diff.getValue());
+                std::vector<uint32_t> welded_other;
+                print_statistics(arg_diff.getValue(), ms.calculate_statistics(other, &welded_other));
+
+                const MeshStats::Distance distance = ms.calculate_distance(mesh, other, &welded, &welded_other);
+                std::cout << "Distance between meshes:" << std::endl;
+                std::cout << boost::format("  Hausdorff:            %g (input -> other: %g, other -> input: %g)")
+                             % distance.hausdorff % distance.hausdorff_ab % distance.hausdorff_ba << std::endl;
+                std::cout << boost::format("  RMS:                  %g (input -> other: %g, other -> input: %g)")
+                             % distance.rms % distance.rms_ab % distance.rms_ba << std::endl;
+
+                if(!std::isfinite(distance.hausdorff)) {
+                    std::cerr << "Distance is undefined: one of the meshes has no triangles" << std::endl;
+                    if(arg_max_distance.getValue() >= 0.0) {
+                        result = 1;
+                    }
+                } else if(arg_max_distance.getValue() >= 0.0 && distance.hausdorff > arg_max_distance.getValue()) {
+                    std::cerr << "Hausdorff distance exceeds " << arg_max_distance.getValue() << std::endl;
+                    result = 1;
+                }
+
+                delete other;
+            }
+
+            delete mesh;
+            return result;
+        }
+
+        if(!arg_output_filename.isSet()) {
+            std::cerr << "error: no output specified (-o)" << std::endl;
+            return -1;
+        }
+
+        if(arg_watch.getValue()) {
+            MeshWatcher watcher(arg_input_filename.getValue(), arg_output_filename.getValue(), arg_debounce.getValue());
+            watcher.run();
+            return 0;
+        }
+
         MeshParser mp;
 
         std::cout << "Opening: " << arg_input_filename.getValue() << std::endl;
@@ -67,5 +152,8 @@ int main(int argc, char* argv[]) {
         std::cerr << "error: " << e.error() <<
                      " for arg " << e.argId() << std::endl;
         return -1;
+    } catch (const std::exception& e) {
+        std::cerr << "error: " << e.what() << std::endl;
+        return -1;
     }
 }
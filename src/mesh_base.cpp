@@ -31,10 +31,10 @@ void MeshBase::add_vertex_pn(unsigned int idx, const glm::vec3& pos, const glm::
     this->normals.push_back(normal);
 }
 
-void MeshBase::add_content(const std::vector<glm::vec3>& _vertices,
-                       const std::vector<glm::vec3>& _normals,
-                       const std::vector<unsigned int>& _indices) {
-    this->indices = _indices;
-    this->vertices = _vertices;
-    this->normals = _normals;
+void MeshBase::add_content(std::vector<glm::vec3> _vertices,
+                       std::vector<glm::vec3> _normals,
+                       std::vector<unsigned int> _indices) {
+    this->indices = std::move(_indices);
+    this->vertices = std::move(_vertices);
+    this->normals = std::move(_normals);
 }
@@ -47,9 +47,9 @@ public:
 
     virtual void add_vertex_pn(uint32_t idx, const glm::vec3& pos, const glm::vec3& normal);
 
-    virtual void add_content(const std::vector<glm::vec3>& _vertices,
-                     const std::vector<glm::vec3>& _normals,
-                     const std::vector<unsigned int>& _indices);
+    virtual void add_content(std::vector<glm::vec3> _vertices,
+                     std::vector<glm::vec3> _normals,
+                     std::vector<unsigned int> _indices);
 
     inline virtual unsigned int get_nr_vertices() const {
         return this->vertices.size();
@@ -71,7 +71,7 @@ public:
         return this->type;
     }
 
-    ~MeshBase() {}
+    virtual ~MeshBase() {}
 
 protected:
 };
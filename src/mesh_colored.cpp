@@ -0,0 +1,43 @@
+/**************************************************************************
+ *   mesh_colored.cpp  --  This file is part of OBJ2BIT.                  *
+ *                                                                        *
+ *   Copyright (C) 2017, Ivo Filot (ivo@ivofilot.nl)                      *
+ *                                                                        *
+ *   OBJ2BIT is free software:                                            *
+ *   you can redistribute it and/or modify it under the terms of the      *
+ *   GNU General Public License as published by the Free Software         *
+ *   Foundation, either version 3 of the License, or (at your option)     *
+ *   any later version.                                                   *
+ *                                                                        *
+ *   OBJ2BIT is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#include "mesh_colored.h"
+
+MeshColored::MeshColored() {
+    this->type = MeshBase::MESH_COLORED;
+}
+
+void MeshColored::add_vertex_pcn(uint32_t idx, const glm::vec3& pos, const glm::vec3& color, const glm::vec3& normal) {
+    this->indices.push_back(idx);
+    this->vertices.push_back(pos);
+    this->colors.push_back(color);
+    this->normals.push_back(normal);
+}
+
+void MeshColored::add_content(std::vector<glm::vec3> _vertices,
+                              std::vector<glm::vec3> _colors,
+                              std::vector<glm::vec3> _normals,
+                              std::vector<unsigned int> _indices) {
+    this->vertices = std::move(_vertices);
+    this->colors = std::move(_colors);
+    this->normals = std::move(_normals);
+    this->indices = std::move(_indices);
+}
@@ -21,12 +21,22 @@
 
 #include "mesh_parser.h"
 
+MeshBase* MeshParser::read(const std::string& filename) {
+    if(boost::algorithm::iends_with(filename, ".obj")) {
+        return this->read_obj(filename);
+    } else if(boost::algorithm::iends_with(filename, ".bin")) {
+        return this->read_bin(filename);
+    } else {
+        return this->read_bz2(filename);
+    }
+}
+
 MeshBase* MeshParser::read_obj(const std::string& filename) {
     std::ifstream f(filename);
     if(f.is_open()) {
 
         // set regex patterns
-        static const boost::regex v_line("v\\s+([0-9.-]+)\\s+([0-9.-]+)\\s+([0-9.-]+).*");
+        static const boost::regex v_line("v\\s+([0-9.-]+)\\s+([0-9.-]+)\\s+([0-9.-]+)(?:\\s+([0-9.-]+)\\s+([0-9.-]+)\\s+([0-9.-]+))?.*");
         static const boost::regex vt_line("vt\\s+([0-9.-]+)\\s+([0-9.-]+).*");
         static const boost::regex vn_line("vn\\s+([0-9.-]+)\\s+([0-9.-]+)\\s+([0-9.-]+).*");
         static const boost::regex f1_line("f\\s+([0-9]+)\\/([0-9]+)\\/([0-9]+)\\s+([0-9]+)\\/([0-9]+)\\/([0-9]+)\\s+([0-9]+)\\/([0-9]+)\\/([0-9]+).*");
@@ -34,6 +44,7 @@ MeshBase* MeshParser::read_obj(const std::string& filename) {
 
         // construct holders
         std::vector<glm::vec3> positions;
+        std::vector<glm::vec3> colors;
         std::vector<glm::vec2> uvs;
         std::vector<glm::vec3> normals;
         std::vector<uint32_t> position_indices;
@@ -50,6 +61,13 @@ MeshBase* MeshParser::read_obj(const std::string& filename) {
                               boost::lexical_cast<float>(what1[2]),
                               boost::lexical_cast<float>(what1[3]));
                 positions.push_back(pos);
+
+                // optional vertex color following the position
+                if(what1[4].matched) {
+                    colors.push_back(glm::vec3(boost::lexical_cast<float>(what1[4]),
+                                               boost::lexical_cast<float>(what1[5]),
+                                               boost::lexical_cast<float>(what1[6])));
+                }
             }
 
             if (boost::regex_match(line, what1, vt_line)) {
@@ -92,17 +110,29 @@ MeshBase* MeshParser::read_obj(const std::string& filename) {
 
         MeshBase* mesh;
 
-        if(uvs.size() == 0) {
-            mesh = reinterpret_cast<MeshBase*>(new MeshSimple());
+        // there is no mesh type carrying both uvs and colors
+        if(uvs.size() != 0 && colors.size() != 0) {
+            std::cerr << "Warning: " << filename << " has both texture coordinates and vertex colors; "
+                      << "vertex colors are discarded" << std::endl;
+        }
+
+        if(uvs.size() != 0) {
+            MeshUV* mesh_uv = new MeshUV();
             for(unsigned int i=0; i<position_indices.size(); i++) {
-                mesh->add_vertex_pn(i, positions[position_indices[i]], normals[normal_indices[i]]);
+                mesh_uv->add_vertex_ptn(i, positions[position_indices[i]], uvs[texture_indices[i]], normals[normal_indices[i]]);
+            }
+            mesh = mesh_uv;
+        } else if(colors.size() != 0 && colors.size() == positions.size()) {
+            MeshColored* mesh_colored = new MeshColored();
+            for(unsigned int i=0; i<position_indices.size(); i++) {
+                mesh_colored->add_vertex_pcn(i, positions[position_indices[i]], colors[position_indices[i]], normals[normal_indices[i]]);
             }
+            mesh = mesh_colored;
         } else {
-            MeshUV* mesh_uv = new MeshUV();
+            mesh = new MeshSimple();
             for(unsigned int i=0; i<position_indices.size(); i++) {
-                mesh_uv->add_vertex_ptn(i, positions[position_indices[i]], uvs[texture_indices[i]], normals[normal_indices[i]]);
+                mesh->add_vertex_pn(i, positions[position_indices[i]], normals[normal_indices[i]]);
             }
-            mesh = reinterpret_cast<MeshBase*>(mesh_uv);
         }
 
         return mesh;
@@ -116,186 +146,94 @@ MeshBase* MeshParser::read_obj(const std::string& filename) {
 }
 
 void MeshParser::write_bin(const std::string& filename, const MeshBase* mesh) {
-    std::ofstream f(filename, std::ios_base::binary);
-
-    if(f.good()) {
-        // write the number of positions
-        const uint32_t nr_vertices = mesh->get_vertices().size();
-        f.write((char*)&nr_vertices, sizeof(uint32_t));
-
-        // write the number of normals
-        const uint32_t nr_normals = mesh->get_normals().size();
-        f.write((char*)&nr_normals, sizeof(uint32_t));
-
-        // write the number of indices
-        const uint32_t nr_indices = mesh->get_indices().size();
-        f.write((char*)&nr_indices, sizeof(uint32_t));
-
-        // write the positions
-        for(const auto& pos : mesh->get_vertices()) {
-            f.write((char*)&pos, sizeof(float) * 3);
-        }
-
-        // write the normals
-        for(const auto& normal : mesh->get_normals()) {
-            f.write((char*)&normal, sizeof(float) * 3);
-        }
-
-        // write the indices
-        for(const auto& idx : mesh->get_indices()) {
-            f.write((char*)&idx, sizeof(uint32_t));
-        }
-
-        f.close();
-
-    } else {
-        std::cerr << "Cannot write to file " << filename << std::endl;
-        throw std::runtime_error("Could not write to file");
-    }
+    visit_mesh(mesh, [&](const auto& m) {
+        this->write_bin<typename std::decay<decltype(m)>::type>(filename, &m);
+    });
 }
 
 void MeshParser::write_bz2(const std::string& filename, const MeshBase* mesh) {
-    std::fstream f(filename, std::ios_base::binary | std::ios::out);
-
-    if(f.good()) {
-
-        std::stringstream compressed;
-        std::stringstream origin;
-
-        // write the number of positions
-        const uint32_t nr_vertices = mesh->get_vertices().size();
-        origin.write((char*)&nr_vertices, sizeof(uint32_t));
-
-        // write the number of uvs
-        if(mesh->get_type() == MeshBase::MESH_UV) {
-            const uint32_t nr_uvs = reinterpret_cast<const MeshUV*>(mesh)->get_uvs().size();
-            origin.write((char*)&nr_uvs, sizeof(uint32_t));
-        }
-        else {
-            const uint32_t nr_uvs = 0;
-            origin.write((char*)&nr_uvs, sizeof(uint32_t));
-        }
-
-        // write the number of normals
-        const uint32_t nr_normals = mesh->get_normals().size();
-        origin.write((char*)&nr_normals, sizeof(uint32_t));
-
-        // write the number of indices
-        const uint32_t nr_indices = mesh->get_indices().size();
-        origin.write((char*)&nr_indices, sizeof(uint32_t));
-
-        // write the positions
-        for(const auto& pos : mesh->get_vertices()) {
-            origin.write((char*)&pos, sizeof(float) * 3);
-        }
-
-        // write the uvs
-        if(mesh->get_type() == MeshBase::MESH_UV) {
-            for(const auto& uv : reinterpret_cast<const MeshUV*>(mesh)->get_uvs()) {
-                origin.write((char*)&uv, sizeof(float) * 2);
-            }
-        }
-
-        // write the normals
-        for(const auto& normal : mesh->get_normals()) {
-            origin.write((char*)&normal, sizeof(float) * 3);
-        }
-
-        // write the indices
-        for(const auto& idx : mesh->get_indices()) {
-            origin.write((char*)&idx, sizeof(uint32_t));
-        }
-
-        boost::iostreams::filtering_streambuf<boost::iostreams::input> out;
-        out.push(boost::iostreams::bzip2_compressor());
-        out.push(origin);
-        boost::iostreams::copy(out, compressed);
-
-        f << compressed.str();
-        f.close();
+    visit_mesh(mesh, [&](const auto& m) {
+        this->write_bz2<typename std::decay<decltype(m)>::type>(filename, &m);
+    });
+}
 
+MeshBase* MeshParser::read_bin(const std::string& filename) {
+    std::ifstream f(filename, std::ios_base::binary);
+    if(f.is_open()) {
+        return read_payload(f);
     } else {
-        std::cerr << "Cannot write to file " << filename << std::endl;
-        throw std::runtime_error("Could not write to file");
+        std::cerr << "Cannot open file " << filename << std::endl;
+        throw std::runtime_error("Could not open file");
     }
 }
 
 MeshBase* MeshParser::read_bz2(const std::string& filename) {
-    std::ifstream f(filename);
+    std::ifstream f(filename, std::ios_base::binary);
     if(f.is_open()) {
+        // decompress straight from the file
+        boost::iostreams::filtering_istream in;
+        in.push(boost::iostreams::bzip2_decompressor());
+        in.push(f);
+        return read_payload(in);
+    } else {
+        std::cerr << "Cannot open file " << filename << std::endl;
+        throw std::runtime_error("Could not open file");
+    }
+}
 
-        std::stringstream compressed;
-        compressed << f.rdbuf();
-        f.close();
-
-        std::stringstream decompressed;
-        boost::iostreams::filtering_streambuf<boost::iostreams::input> out;
-        out.push(boost::iostreams::bzip2_decompressor());
-        out.push(compressed);
-        boost::iostreams::copy(out, decompressed);
-
-        // create read buffer
-        char* buffer = new char[sizeof(float) * 3];
-
-        // read nr positions
-        decompressed.read(buffer, sizeof(uint32_t));
-        const uint32_t nr_positions = *(uint32_t *)buffer;
-
-        // read nr texture_coordinates
-        decompressed.read(buffer, sizeof(uint32_t));
-        const uint32_t nr_textures = *(uint32_t *)buffer;
-
-        // read nr normals
-        decompressed.read(buffer, sizeof(uint32_t));
-        const uint32_t nr_normals = *(uint32_t *)buffer;
-
-        // read nr indices
-        decompressed.read(buffer, sizeof(uint32_t));
-        const uint32_t nr_indices = *(uint32_t *)buffer;
-
-        std::vector<glm::vec3> positions;
-        std::vector<glm::vec2> uvs;
-        std::vector<glm::vec3> normals;
-        std::vector<uint32_t> indices;
-
-        for(unsigned int i=0; i<nr_positions; i++) {
-            decompressed.read(buffer, sizeof(float) * 3);
-            positions.push_back(*(glm::vec3 *)buffer);
-        }
-
-        for(unsigned int i=0; i<nr_textures; i++) {
-            decompressed.read(buffer, sizeof(float) * 2);
-            uvs.push_back(*(glm::vec2 *)buffer);
-        }
-
-        for(unsigned int i=0; i<nr_normals; i++) {
-            decompressed.read(buffer, sizeof(float) * 3);
-            normals.push_back(*(glm::vec3 *)buffer);
-        }
-
-        for(unsigned int i=0; i<nr_indices; i++) {
-            decompressed.read(buffer, sizeof(uint32_t));
-            indices.push_back(*(uint32_t *)buffer);
-        }
+MeshBase* MeshParser::read_payload(std::istream& in) {
+    // read nr positions, texture coordinates, normals and indices
+    uint32_t header[4];
+    if(!in.read((char*)header, sizeof(header))) {
+        throw std::runtime_error("Unexpected end of mesh data");
+    }
 
-        // delete old buffer
-        delete[] buffer;
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec2> uvs;
+    std::vector<glm::vec3> normals;
+    std::vector<uint32_t> indices;
+    std::vector<glm::vec3> colors;
+
+    read_block(in, positions, header[0]);
+    read_block(in, uvs, header[1]);
+    read_block(in, normals, header[2]);
+    read_block(in, indices, header[3]);
+
+    // colored meshes carry a trailing color block
+    uint32_t nr_colors = 0;
+    if(in.read((char*)&nr_colors, sizeof(uint32_t))) {
+        read_block(in, colors, nr_colors);
+    }
 
-        MeshBase* mesh;
+    // reject corrupt data here rather than letting it crash later users
+    if(indices.size() % 3 != 0) {
+        throw std::runtime_error("Number of indices is not a multiple of three");
+    }
 
-        if(uvs.size() == 0) {
-            mesh = reinterpret_cast<MeshBase*>(new MeshSimple());
-            mesh->add_content(positions, normals, indices);
-        } else {
-            MeshUV* mesh_uv = new MeshUV();
-            mesh_uv->add_content(positions, uvs, normals, indices);
-            mesh = reinterpret_cast<MeshBase*>(mesh_uv);
+    for(const uint32_t idx : indices) {
+        if(idx >= positions.size()) {
+            throw std::runtime_error("Index out of range of the vertices");
         }
+    }
 
-        return mesh;
+    // per-vertex attributes are either absent or given for every vertex
+    if((uvs.size() != 0 && uvs.size() != positions.size()) ||
+       (normals.size() != 0 && normals.size() != positions.size()) ||
+       (colors.size() != 0 && colors.size() != positions.size())) {
+        throw std::runtime_error("Number of vertex attributes does not match the number of vertices");
+    }
 
+    if(uvs.size() != 0) {
+        MeshUV* mesh_uv = new MeshUV();
+        mesh_uv->add_content(std::move(positions), std::move(uvs), std::move(normals), std::move(indices));
+        return mesh_uv;
+    } else if(colors.size() != 0) {
+        MeshColored* mesh_colored = new MeshColored();
+        mesh_colored->add_content(std::move(positions), std::move(colors), std::move(normals), std::move(indices));
+        return mesh_colored;
     } else {
-        std::cerr << "Cannot write to file " << filename << std::endl;
-        throw std::runtime_error("Could not write to file");
+        MeshBase* mesh = new MeshSimple();
+        mesh->add_content(std::move(positions), std::move(normals), std::move(indices));
+        return mesh;
     }
 }
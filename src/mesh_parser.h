@@ -23,6 +23,7 @@
 #define _MESH_PARSER_H
 
 #include <string>
+#include <algorithm>
 #include <stdexcept>
 #include <fstream>
 #include <iostream>
@@ -32,31 +33,160 @@
 #include <boost/lexical_cast.hpp>
 #include <boost/algorithm/string.hpp>
 #include <boost/iostreams/filtering_streambuf.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
 #include <boost/iostreams/copy.hpp>
 #include <boost/iostreams/filter/bzip2.hpp>
 
 #include "mesh_base.h"
 #include "mesh_simple.h"
 #include "mesh_uv.h"
+#include "mesh_colored.h"
+#include "mesh_traits.h"
 
+/*
+ * The binary formats share a single payload, written either as is (bin)
+ * or bzip2-compressed (bz2):
+ *
+ *   uint32 nr_vertices, nr_uvs, nr_normals, nr_indices
+ *   vertices (3 floats), uvs (2 floats), normals (3 floats), indices (uint32)
+ *   [uint32 nr_colors, colors (3 floats)]   -- colored meshes only
+ *
+ * Readers that do not know about colors simply ignore the trailing block.
+ */
 class MeshParser {
 private:
 
 public:
     MeshParser() {}
 
+    // read an OBJ file (.obj), an uncompressed binary mesh (.bin) or a
+    // compressed binary mesh (any other extension)
+    MeshBase* read(const std::string& filename);
+
     MeshBase* read_obj(const std::string& filename);
 
     void write_bin(const std::string& filename, const MeshBase*);
 
     void write_bz2(const std::string& filename, const MeshBase*);
 
+    MeshBase* read_bin(const std::string& filename);
+
     MeshBase* read_bz2(const std::string& filename);
 
+    /*
+     * Writers specialized for a concrete mesh type; these are picked over
+     * the overloads above when the static type of the mesh is known
+     */
+    template<class MeshT>
+    void write_bin(const std::string& filename, const MeshT* mesh);
+
+    template<class MeshT>
+    void write_bz2(const std::string& filename, const MeshT* mesh);
+
 private:
+    template<class MeshT>
+    static void write_payload(std::ostream& out, const MeshT& mesh);
+
+    static MeshBase* read_payload(std::istream& in);
 
+    template<typename T>
+    static void write_block(std::ostream& out, const std::vector<T>& data);
+
+    template<typename T>
+    static void read_block(std::istream& in, std::vector<T>& data, uint32_t nr_elements);
 };
 
+template<class MeshT>
+void MeshParser::write_bin(const std::string& filename, const MeshT* mesh) {
+    std::ofstream f(filename, std::ios_base::binary);
+
+    if(f.good()) {
+        write_payload(f, *mesh);
+        f.close();
+    }
+
+    if(!f.good()) {
+        std::cerr << "Cannot write to file " << filename << std::endl;
+        throw std::runtime_error("Could not write to file");
+    }
+}
+
+template<class MeshT>
+void MeshParser::write_bz2(const std::string& filename, const MeshT* mesh) {
+    std::ofstream f(filename, std::ios_base::binary);
+
+    if(f.good()) {
+        // compress straight into the file
+        boost::iostreams::filtering_ostream out;
+        out.push(boost::iostreams::bzip2_compressor());
+        out.push(f);
+        write_payload(out, *mesh);
+        out.reset();
+        f.close();
+    }
+
+    if(!f.good()) {
+        std::cerr << "Cannot write to file " << filename << std::endl;
+        throw std::runtime_error("Could not write to file");
+    }
+}
+
+template<class MeshT>
+void MeshParser::write_payload(std::ostream& out, const MeshT& mesh) {
+    typedef MeshTraits<MeshT> traits;
+
+    // the layout below is chosen from the static type only
+    if(mesh.get_type() != traits::type) {
+        throw std::runtime_error("Mesh type does not match its static type");
+    }
+
+    // write the number of positions, uvs, normals and indices
+    const uint32_t header[4] = {
+        (uint32_t)mesh.get_vertices().size(),
+        (uint32_t)traits::get_uvs(mesh).size(),
+        (uint32_t)mesh.get_normals().size(),
+        (uint32_t)mesh.get_indices().size()
+    };
+    out.write((const char*)header, sizeof(header));
+
+    write_block(out, mesh.get_vertices());
+    if(traits::has_uvs) {
+        write_block(out, traits::get_uvs(mesh));
+    }
+    write_block(out, mesh.get_normals());
+    write_block(out, mesh.get_indices());
+
+    if(traits::has_colors) {
+        const uint32_t nr_colors = traits::get_colors(mesh).size();
+        out.write((const char*)&nr_colors, sizeof(uint32_t));
+        write_block(out, traits::get_colors(mesh));
+    }
+}
+
+template<typename T>
+void MeshParser::write_block(std::ostream& out, const std::vector<T>& data) {
+    if(!data.empty()) {
+        out.write((const char*)data.data(), data.size() * sizeof(T));
+    }
+}
+
+template<typename T>
+void MeshParser::read_block(std::istream& in, std::vector<T>& data, uint32_t nr_elements) {
+    // grow the array in bounded chunks as data arrives, so that a corrupt
+    // count cannot trigger a huge allocation before the data runs out
+    static const size_t chunk_size = (16 << 20) / sizeof(T);
+
+    data.clear();
+    while(data.size() < nr_elements) {
+        const size_t offset = data.size();
+        const size_t count = std::min<size_t>(chunk_size, nr_elements - offset);
+        data.resize(offset + count);
+        if(!in.read((char*)(data.data() + offset), (std::streamsize)(count * sizeof(T)))) {
+            throw std::runtime_error("Unexpected end of mesh data");
+        }
+    }
+}
+
 // define comparison function for glm::vec3
 static uint8_t comp_vec3(const glm::vec3& lhs, float x, float y, float z) {
     uint8_t result = 0;
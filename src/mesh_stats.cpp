@@ -0,0 +1,282 @@
+/**************************************************************************
+ *   mesh_stats.cpp  --  This file is part of OBJ2BIT.                    *
+ *                                                                        *
+ *   Copyright (C) 2017, Ivo Filot (ivo@ivofilot.nl)                      *
+ *                                                                        *
+ *   OBJ2BIT is free software:                                            *
+ *   you can redistribute it and/or modify it under the terms of the      *
+ *   GNU General Public License as published by the Free Software         *
+ *   Foundation, either version 3 of the License, or (at your option)     *
+ *   any later version.                                                   *
+ *                                                                        *
+ *   OBJ2BIT is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#include "mesh_stats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <tuple>
+
+#include "bvh.h"
+#include "parallel.h"
+
+MeshStats::MeshStats(unsigned int _nr_threads) :
+    nr_threads(get_nr_threads(_nr_threads)) {}
+
+MeshStats::Statistics MeshStats::calculate_statistics(const MeshBase* mesh,
+                                                     std::vector<uint32_t>* welded_out) const {
+    const std::vector<glm::vec3>& vertices = mesh->get_vertices();
+    const std::vector<uint32_t>& indices = mesh->get_indices();
+    const size_t nr_triangles = indices.size() / 3;
+
+    Statistics stats;
+    stats.nr_triangles = nr_triangles;
+    stats.nr_vertices = vertices.size();
+
+    std::vector<uint32_t> welded_local;
+    std::vector<uint32_t>& welded = welded_out != nullptr ? *welded_out : welded_local;
+    welded = this->weld_vertices(mesh);
+    stats.nr_unique_vertices = 0;
+    for(size_t i=0; i<welded.size(); i++) {
+        if(welded[i] == i) {
+            stats.nr_unique_vertices++;
+        }
+    }
+
+    // per-thread partial results
+    struct Partial {
+        glm::vec3 aabb_min = glm::vec3(std::numeric_limits<float>::max());
+        glm::vec3 aabb_max = glm::vec3(-std::numeric_limits<float>::max());
+        double area = 0.0;
+        double volume = 0.0;
+        size_t nr_degenerate = 0;
+    };
+    std::vector<Partial> partials(this->nr_threads);
+
+    // volumes are taken relative to a point on the mesh to limit the loss
+    // of precision for meshes far away from the origin
+    const glm::vec3 origin = vertices.empty() ? glm::vec3(0.0f) : vertices[0];
+
+    parallel_for(nr_triangles, this->nr_threads, [&](unsigned int thread_id, size_t begin, size_t end) {
+        Partial& partial = partials[thread_id];
+        for(size_t i=begin; i<end; i++) {
+            const glm::vec3& p0 = vertices[indices[i*3]];
+            const glm::vec3& p1 = vertices[indices[i*3+1]];
+            const glm::vec3& p2 = vertices[indices[i*3+2]];
+
+            partial.aabb_min = glm::min(partial.aabb_min, glm::min(p0, glm::min(p1, p2)));
+            partial.aabb_max = glm::max(partial.aabb_max, glm::max(p0, glm::max(p1, p2)));
+
+            const glm::vec3 a = p0 - origin;
+            const glm::vec3 b = p1 - origin;
+            const glm::vec3 c = p2 - origin;
+
+            const glm::vec3 n = glm::cross(b - a, c - a);
+            const float n_length = glm::length(n);
+            partial.area += 0.5 * n_length;
+            partial.volume += glm::dot(a, glm::cross(b, c)) / 6.0;
+
+            const float max_edge2 = std::max(glm::dot(b - a, b - a),
+                                    std::max(glm::dot(c - b, c - b), glm::dot(a - c, a - c)));
+            if(welded[indices[i*3]] == welded[indices[i*3+1]] ||
+               welded[indices[i*3+1]] == welded[indices[i*3+2]] ||
+               welded[indices[i*3+2]] == welded[indices[i*3]] ||
+               n_length <= std::numeric_limits<float>::epsilon() * max_edge2) {
+                partial.nr_degenerate++;
+            }
+        }
+    });
+
+    Partial total;
+    for(const auto& partial : partials) {
+        total.aabb_min = glm::min(total.aabb_min, partial.aabb_min);
+        total.aabb_max = glm::max(total.aabb_max, partial.aabb_max);
+        total.area += partial.area;
+        total.volume += partial.volume;
+        total.nr_degenerate += partial.nr_degenerate;
+    }
+
+    stats.aabb_min = nr_triangles > 0 ? total.aabb_min : glm::vec3(0.0f);
+    stats.aabb_max = nr_triangles > 0 ? total.aabb_max : glm::vec3(0.0f);
+    stats.surface_area = total.area;
+    stats.volume = total.volume;
+    stats.nr_degenerate_triangles = total.nr_degenerate;
+
+    // two triangles are duplicates when they share the same three welded
+    // vertices, regardless of order or orientation
+    typedef std::tuple<uint32_t, uint32_t, uint32_t> TriangleKey;
+    std::vector<TriangleKey> keys(nr_triangles);
+    parallel_for(nr_triangles, this->nr_threads, [&](unsigned int, size_t begin, size_t end) {
+        for(size_t i=begin; i<end; i++) {
+            uint32_t v[3] = {welded[indices[i*3]], welded[indices[i*3+1]], welded[indices[i*3+2]]};
+            std::sort(v, v + 3);
+            keys[i] = std::make_tuple(v[0], v[1], v[2]);
+        }
+    });
+    parallel_sort(keys.begin(), keys.end(), std::less<TriangleKey>(), this->nr_threads);
+
+    stats.nr_duplicate_triangles = 0;
+    for(size_t i=1; i<keys.size(); i++) {
+        if(keys[i] == keys[i-1]) {
+            stats.nr_duplicate_triangles++;
+        }
+    }
+
+    return stats;
+}
+
+MeshStats::Distance MeshStats::calculate_distance(const MeshBase* mesh_a, const MeshBase* mesh_b,
+                                                 const std::vector<uint32_t>* welded_a,
+                                                 const std::vector<uint32_t>* welded_b) const {
+    Distance distance;
+
+    // the distance to a mesh without a surface is undefined; report it as
+    // infinite so that any threshold on it fails
+    if(mesh_a->get_indices().size() < 3 || mesh_b->get_indices().size() < 3) {
+        const double inf = std::numeric_limits<double>::infinity();
+        distance = {inf, inf, inf, inf, inf, inf};
+        return distance;
+    }
+
+    double sum_ab = 0.0, sum_ba = 0.0;
+    double area_a = 0.0, area_b = 0.0;
+    this->calculate_one_sided_distance(mesh_a, mesh_b, welded_a, &distance.hausdorff_ab, &sum_ab, &area_a);
+    this->calculate_one_sided_distance(mesh_b, mesh_a, welded_b, &distance.hausdorff_ba, &sum_ba, &area_b);
+
+    distance.hausdorff = std::max(distance.hausdorff_ab, distance.hausdorff_ba);
+
+    // meshes consisting of degenerate triangles only have no area to
+    // average over
+    distance.rms_ab = area_a > 0.0 ? std::sqrt(sum_ab / area_a) : 0.0;
+    distance.rms_ba = area_b > 0.0 ? std::sqrt(sum_ba / area_b) : 0.0;
+    distance.rms = (area_a + area_b) > 0.0 ? std::sqrt((sum_ab + sum_ba) / (area_a + area_b)) : 0.0;
+
+    return distance;
+}
+
+std::vector<uint32_t> MeshStats::weld_vertices(const MeshBase* mesh) const {
+    const std::vector<glm::vec3>& vertices = mesh->get_vertices();
+
+    // sort (position, index) records by position; ties are broken by index
+    // so that the first vertex of every group is the one with the lowest index
+    struct Record {
+        glm::vec3 pos;
+        uint32_t idx;
+    };
+
+    std::vector<Record> records(vertices.size());
+    parallel_for(vertices.size(), this->nr_threads, [&](unsigned int, size_t begin, size_t end) {
+        for(size_t i=begin; i<end; i++) {
+            records[i] = {vertices[i], (uint32_t)i};
+        }
+    });
+
+    parallel_sort(records.begin(), records.end(), [](const Record& a, const Record& b) {
+        if(a.pos.x != b.pos.x) return a.pos.x < b.pos.x;
+        if(a.pos.y != b.pos.y) return a.pos.y < b.pos.y;
+        if(a.pos.z != b.pos.z) return a.pos.z < b.pos.z;
+        return a.idx < b.idx;
+    }, this->nr_threads);
+
+    std::vector<uint32_t> welded(vertices.size());
+    uint32_t representative = 0;
+    for(size_t i=0; i<records.size(); i++) {
+        if(i == 0 || records[i].pos != records[i-1].pos) {
+            representative = records[i].idx;
+        }
+        welded[records[i].idx] = representative;
+    }
+
+    return welded;
+}
+
+void MeshStats::calculate_one_sided_distance(const MeshBase* from, const MeshBase* to,
+                                             const std::vector<uint32_t>* welded_from,
+                                             double* max_distance, double* sum_distance2,
+                                             double* sum_area) const {
+    const BVH bvh(to, this->nr_threads);
+    const std::vector<glm::vec3>& vertices = from->get_vertices();
+    const std::vector<uint32_t>& indices = from->get_indices();
+    std::vector<uint32_t> welded_local;
+    if(welded_from == nullptr) {
+        welded_local = this->weld_vertices(from);
+        welded_from = &welded_local;
+    }
+    const std::vector<uint32_t>& welded = *welded_from;
+
+    struct Partial {
+        float max_distance2 = 0.0f;
+        double sum_distance2 = 0.0;
+        double sum_area = 0.0;
+    };
+    std::vector<Partial> partials(this->nr_threads);
+
+    // vertices are visited in mesh order, in which successive vertices are
+    // usually close, so the previous closest triangle is a good hint; the
+    // distances are kept for the surface integral below
+    std::vector<float> vertex_distance2(vertices.size());
+    parallel_for(vertices.size(), this->nr_threads, [&](unsigned int thread_id, size_t begin, size_t end) {
+        Partial& partial = partials[thread_id];
+        uint32_t hint = std::numeric_limits<uint32_t>::max();
+        for(size_t i=begin; i<end; i++) {
+            if(welded[i] != i) {
+                continue;
+            }
+
+            vertex_distance2[i] = bvh.closest_distance2(vertices[i], &hint);
+            partial.max_distance2 = std::max(partial.max_distance2, vertex_distance2[i]);
+        }
+    });
+
+    // the vertices alone miss deviations inside the triangles, such as a
+    // gap in one mesh that is bridged by the other; every triangle is also
+    // sampled at its edge midpoints and centroid and the squared distance
+    // is integrated with the seven-point rule, which weighs the corners by
+    // 1/20, the midpoints by 2/15 and the centroid by 9/20 of the area
+    parallel_for(indices.size() / 3, this->nr_threads, [&](unsigned int thread_id, size_t begin, size_t end) {
+        Partial& partial = partials[thread_id];
+        uint32_t hint = std::numeric_limits<uint32_t>::max();
+        for(size_t i=begin; i<end; i++) {
+            const glm::vec3& p0 = vertices[indices[i*3]];
+            const glm::vec3& p1 = vertices[indices[i*3+1]];
+            const glm::vec3& p2 = vertices[indices[i*3+2]];
+            const double area = 0.5 * glm::length(glm::cross(p1 - p0, p2 - p0));
+
+            const float d2_corners = vertex_distance2[welded[indices[i*3]]] +
+                                     vertex_distance2[welded[indices[i*3+1]]] +
+                                     vertex_distance2[welded[indices[i*3+2]]];
+
+            const float d2_m01 = bvh.closest_distance2(0.5f * (p0 + p1), &hint);
+            const float d2_m12 = bvh.closest_distance2(0.5f * (p1 + p2), &hint);
+            const float d2_m20 = bvh.closest_distance2(0.5f * (p2 + p0), &hint);
+            const float d2_centroid = bvh.closest_distance2((p0 + p1 + p2) / 3.0f, &hint);
+
+            partial.max_distance2 = std::max(partial.max_distance2,
+                                    std::max(std::max(d2_m01, d2_m12), std::max(d2_m20, d2_centroid)));
+            partial.sum_distance2 += area * (d2_corners / 20.0 +
+                                             (d2_m01 + d2_m12 + d2_m20) * 2.0 / 15.0 +
+                                             d2_centroid * 9.0 / 20.0);
+            partial.sum_area += area;
+        }
+    });
+
+    float max_distance2 = 0.0f;
+    *sum_distance2 = 0.0;
+    *sum_area = 0.0;
+    for(const auto& partial : partials) {
+        max_distance2 = std::max(max_distance2, partial.max_distance2);
+        *sum_distance2 += partial.sum_distance2;
+        *sum_area += partial.sum_area;
+    }
+    *max_distance = std::sqrt((double)max_distance2);
+}
@@ -0,0 +1,101 @@
+/**************************************************************************
+ *   mesh_stats.h  --  This file is part of OBJ2BIT.                      *
+ *                                                                        *
+ *   Copyright (C) 2017, Ivo Filot (ivo@ivofilot.nl)                      *
+ *                                                                        *
+ *   OBJ2BIT is free software:                                            *
+ *   you can redistribute it and/or modify it under the terms of the      *
+ *   GNU General Public License as published by the Free Software         *
+ *   Foundation, either version 3 of the License, or (at your option)     *
+ *   any later version.                                                   *
+ *                                                                        *
+ *   OBJ2BIT is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#ifndef _MESH_STATS_H
+#define _MESH_STATS_H
+
+#include <vector>
+
+#include "mesh_base.h"
+
+/*
+ * Geometric statistics of a single mesh and distances between two meshes.
+ * All heavy loops run on nr_threads threads (0 = all hardware threads).
+ */
+class MeshStats {
+public:
+    struct Statistics {
+        size_t nr_triangles;
+        size_t nr_vertices;
+        size_t nr_unique_vertices;          // vertices with a distinct position
+        size_t nr_degenerate_triangles;     // zero area or repeated vertex
+        size_t nr_duplicate_triangles;      // same vertices as an earlier triangle
+        glm::vec3 aabb_min;
+        glm::vec3 aabb_max;
+        double surface_area;
+        double volume;                      // signed; only meaningful for closed meshes
+    };
+
+    /*
+     * Distances are evaluated from points on one mesh (its vertices, edge
+     * midpoints and triangle centroids) to the surface of the other mesh,
+     * in both directions. The RMS values are weighted by surface area. All
+     * distances are infinite when either mesh has no triangles
+     */
+    struct Distance {
+        double hausdorff;                   // max(hausdorff_ab, hausdorff_ba)
+        double hausdorff_ab;
+        double hausdorff_ba;
+        double rms;                         // over the surfaces of both meshes
+        double rms_ab;
+        double rms_ba;
+    };
+
+private:
+    unsigned int nr_threads;
+
+public:
+    MeshStats(unsigned int _nr_threads = 0);
+
+    /*
+     * The map of each vertex onto its welded vertex is stored in welded
+     * when given, so that it can be passed on to calculate_distance
+     */
+    Statistics calculate_statistics(const MeshBase* mesh,
+                                    std::vector<uint32_t>* welded = nullptr) const;
+
+    /*
+     * Weld maps from calculate_statistics can be supplied to avoid welding
+     * the meshes again
+     */
+    Distance calculate_distance(const MeshBase* mesh_a, const MeshBase* mesh_b,
+                                const std::vector<uint32_t>* welded_a = nullptr,
+                                const std::vector<uint32_t>* welded_b = nullptr) const;
+
+private:
+    /*
+     * Map every vertex onto the lowest-indexed vertex sharing its position;
+     * a vertex is unique when it maps onto itself
+     */
+    std::vector<uint32_t> weld_vertices(const MeshBase* mesh) const;
+
+    /*
+     * One-sided distance from the surface of one mesh to the surface of
+     * the other; stores the maximum over all samples, the squared distance
+     * integrated over the surface and the area of the surface
+     */
+    void calculate_one_sided_distance(const MeshBase* from, const MeshBase* to,
+                                      const std::vector<uint32_t>* welded_from,
+                                      double* max_distance, double* sum_distance2,
+                                      double* sum_area) const;
+};
+
+#endif //_MESH_STATS_H
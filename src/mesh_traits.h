@@ -0,0 +1,111 @@
+/**************************************************************************
+ *   mesh_traits.h  --  This file is part of OBJ2BIT.                     *
+ *                                                                        *
+ *   Copyright (C) 2017, Ivo Filot (ivo@ivofilot.nl)                      *
+ *                                                                        *
+ *   OBJ2BIT is free software:                                            *
+ *   you can redistribute it and/or modify it under the terms of the      *
+ *   GNU General Public License as published by the Free Software         *
+ *   Foundation, either version 3 of the License, or (at your option)     *
+ *   any later version.                                                   *
+ *                                                                        *
+ *   OBJ2BIT is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#ifndef _MESH_TRAITS_H
+#define _MESH_TRAITS_H
+
+#include <stdexcept>
+
+#include "mesh_base.h"
+#include "mesh_simple.h"
+#include "mesh_uv.h"
+#include "mesh_colored.h"
+
+// the serializers copy attribute arrays as raw memory
+static_assert(sizeof(glm::vec2) == 2 * sizeof(float), "glm::vec2 must be tightly packed");
+static_assert(sizeof(glm::vec3) == 3 * sizeof(float), "glm::vec3 must be tightly packed");
+
+/*
+ * Compile-time description of the vertex attributes of a mesh type. The
+ * accessors return an empty array for attributes the type does not have,
+ * so that generic code compiles for every mesh type and branches on the
+ * constants are resolved at compile time.
+ */
+template<class MeshT>
+struct MeshTraits;
+
+template<>
+struct MeshTraits<MeshBase> {
+    static const unsigned int type = MeshBase::MESH_BASE;
+    static const bool has_uvs = false;
+    static const bool has_colors = false;
+
+    static const std::vector<glm::vec2>& get_uvs(const MeshBase&) {
+        static const std::vector<glm::vec2> empty;
+        return empty;
+    }
+
+    static const std::vector<glm::vec3>& get_colors(const MeshBase&) {
+        static const std::vector<glm::vec3> empty;
+        return empty;
+    }
+};
+
+template<>
+struct MeshTraits<MeshSimple> : public MeshTraits<MeshBase> {
+    static const unsigned int type = MeshBase::MESH_SIMPLE;
+};
+
+template<>
+struct MeshTraits<MeshUV> : public MeshTraits<MeshBase> {
+    static const unsigned int type = MeshBase::MESH_UV;
+    static const bool has_uvs = true;
+
+    static const std::vector<glm::vec2>& get_uvs(const MeshUV& mesh) {
+        return mesh.get_uvs();
+    }
+};
+
+template<>
+struct MeshTraits<MeshColored> : public MeshTraits<MeshBase> {
+    static const unsigned int type = MeshBase::MESH_COLORED;
+    static const bool has_colors = true;
+
+    static const std::vector<glm::vec3>& get_colors(const MeshColored& mesh) {
+        return mesh.get_colors();
+    }
+};
+
+/*
+ * Call func with the mesh cast to its concrete type; this is the only
+ * place where the runtime type of a mesh is inspected
+ */
+template<typename Func>
+void visit_mesh(const MeshBase* mesh, Func func) {
+    switch(mesh->get_type()) {
+        case MeshBase::MESH_BASE:
+            func(*mesh);
+            break;
+        case MeshBase::MESH_SIMPLE:
+            func(*static_cast<const MeshSimple*>(mesh));
+            break;
+        case MeshBase::MESH_UV:
+            func(*static_cast<const MeshUV*>(mesh));
+            break;
+        case MeshBase::MESH_COLORED:
+            func(*static_cast<const MeshColored*>(mesh));
+            break;
+        default:
+            throw std::runtime_error("Unknown mesh type");
+    }
+}
+
+#endif //_MESH_TRAITS_H
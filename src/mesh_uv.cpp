@@ -32,12 +32,12 @@ void MeshUV::add_vertex_ptn(uint32_t idx, const glm::vec3& pos, const glm::vec2&
     this->normals.push_back(normal);
 }
 
-void MeshUV::add_content(const std::vector<glm::vec3>& _vertices,
-                         const std::vector<glm::vec2>& _uvs,
-                         const std::vector<glm::vec3>& _normals,
-                         const std::vector<unsigned int>& _indices) {
-    this->vertices = _vertices;
-    this->uvs = _uvs;
-    this->normals = _normals;
-    this->indices = _indices;
+void MeshUV::add_content(std::vector<glm::vec3> _vertices,
+                         std::vector<glm::vec2> _uvs,
+                         std::vector<glm::vec3> _normals,
+                         std::vector<unsigned int> _indices) {
+    this->vertices = std::move(_vertices);
+    this->uvs = std::move(_uvs);
+    this->normals = std::move(_normals);
+    this->indices = std::move(_indices);
 }
@@ -33,10 +33,10 @@ public:
 
     virtual void add_vertex_ptn(uint32_t idx, const glm::vec3& pos, const glm::vec2& uv, const glm::vec3& normal);
 
-    virtual void add_content(const std::vector<glm::vec3>& _vertices,
-                             const std::vector<glm::vec2>& _uvs,
-                             const std::vector<glm::vec3>& _normals,
-                             const std::vector<unsigned int>& _indices);
+    virtual void add_content(std::vector<glm::vec3> _vertices,
+                             std::vector<glm::vec2> _uvs,
+                             std::vector<glm::vec3> _normals,
+                             std::vector<unsigned int> _indices);
 
     inline const std::vector<glm::vec2>& get_uvs() const {
         return this->uvs;
@@ -0,0 +1,304 @@
+/**************************************************************************
+ *   mesh_watcher.cpp  --  This file is part of OBJ2BIT.                  *
+ *                                                                        *
+ *   Copyright (C) 2017, Ivo Filot (ivo@ivofilot.nl)                      *
+ *                                                                        *
+ *   OBJ2BIT is free software:                                            *
+ *   you can redistribute it and/or modify it under the terms of the      *
+ *   GNU General Public License as published by the Free Software         *
+ *   Foundation, either version 3 of the License, or (at your option)     *
+ *   any later version.                                                   *
+ *                                                                        *
+ *   OBJ2BIT is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#include "mesh_watcher.h"
+
+#include <sys/stat.h>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <poll.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+volatile std::sig_atomic_t MeshWatcher::stop_requested = 0;
+
+MeshWatcher::MeshWatcher(const std::string& _input_dir,
+                         const std::string& _output_dir,
+                         unsigned int _debounce_ms) :
+    input_dir(_input_dir),
+    output_dir(_output_dir),
+    debounce_ms(_debounce_ms) {
+
+    if(!boost::filesystem::is_directory(this->input_dir)) {
+        std::cerr << "Cannot watch " << _input_dir << ": not a directory" << std::endl;
+        throw std::runtime_error("Input is not a directory");
+    }
+
+    if(!boost::filesystem::is_directory(this->output_dir)) {
+        boost::filesystem::create_directories(this->output_dir);
+    }
+}
+
+void MeshWatcher::run() {
+#ifdef __linux__
+    int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if(fd < 0) {
+        throw std::runtime_error("Could not initialize inotify");
+    }
+
+    // only react once a writer has closed the file or an editor has moved
+    // its temporary file into place
+    if(inotify_add_watch(fd, this->input_dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        close(fd);
+        std::cerr << "Cannot watch " << this->input_dir.string() << std::endl;
+        throw std::runtime_error("Could not watch directory");
+    }
+
+    // keep SIGINT and SIGTERM blocked except while waiting in ppoll, so
+    // that a stop request cannot slip in between the check of the flag
+    // and the start of the wait
+    sigset_t stop_signals;
+    sigset_t original_mask;
+    sigemptyset(&stop_signals);
+    sigaddset(&stop_signals, SIGINT);
+    sigaddset(&stop_signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &stop_signals, &original_mask);
+
+    std::signal(SIGINT, MeshWatcher::handle_signal);
+    std::signal(SIGTERM, MeshWatcher::handle_signal);
+
+    // queue rather than convert the initial backlog, so that a stop
+    // request is honoured between files
+    this->scan();
+
+    std::cout << "Watching: " << this->input_dir.string() << std::endl;
+
+    alignas(struct inotify_event) char buffer[4096];
+    struct pollfd pfd = {fd, POLLIN, 0};
+
+    while(!stop_requested) {
+        // sleep until either a new event arrives or the earliest pending
+        // job has been quiet for long enough
+        struct timespec timeout;
+        struct timespec* timeout_ptr = nullptr;
+        if(!this->pending.empty()) {
+            const auto now = clock::now();
+            auto earliest = clock::time_point::max();
+            for(const auto& job : this->pending) {
+                earliest = std::min(earliest, job.second.last_event + std::chrono::milliseconds(this->debounce_ms));
+            }
+            const auto wait_ns = std::max<int64_t>(0, std::chrono::duration_cast<std::chrono::nanoseconds>(earliest - now).count());
+            timeout.tv_sec = wait_ns / 1000000000;
+            timeout.tv_nsec = wait_ns % 1000000000;
+            timeout_ptr = &timeout;
+        }
+
+        int ready = ppoll(&pfd, 1, timeout_ptr, &original_mask);
+        if(ready < 0) {
+            if(errno == EINTR) {
+                continue;
+            }
+            pthread_sigmask(SIG_SETMASK, &original_mask, nullptr);
+            close(fd);
+            throw std::runtime_error("Could not poll inotify descriptor");
+        }
+
+        if(ready > 0 && (pfd.revents & POLLIN)) {
+            bool overflow = false;
+            ssize_t len;
+            while((len = read(fd, buffer, sizeof(buffer))) > 0) {
+                const auto now = clock::now();
+                for(char* ptr = buffer; ptr < buffer + len; ) {
+                    const struct inotify_event* event = (const struct inotify_event*)ptr;
+                    ptr += sizeof(struct inotify_event) + event->len;
+
+                    if(event->mask & IN_Q_OVERFLOW) {
+                        overflow = true;
+                        continue;
+                    }
+
+                    if(event->len == 0 || !is_obj_file(event->name)) {
+                        continue;
+                    }
+
+                    auto it = this->pending.find(event->name);
+                    if(it == this->pending.end()) {
+                        this->pending.emplace(event->name, PendingJob{now, now});
+                    } else {
+                        it->second.last_event = now;
+                    }
+                }
+            }
+
+            // events were dropped; fall back to comparing timestamps
+            if(overflow) {
+                std::cerr << "Event queue overflowed, rescanning " << this->input_dir.string() << std::endl;
+                this->scan();
+            }
+        }
+
+        this->process_pending();
+    }
+
+    pthread_sigmask(SIG_SETMASK, &original_mask, nullptr);
+    close(fd);
+    std::cout << "Stopped watching " << this->input_dir.string() << std::endl;
+#else
+    throw std::runtime_error("Watch mode requires inotify and is only available on Linux");
+#endif
+}
+
+void MeshWatcher::scan() {
+    for(const auto& entry : boost::filesystem::directory_iterator(this->input_dir)) {
+        const std::string filename = entry.path().filename().string();
+        if(!boost::filesystem::is_regular_file(entry.path()) || !is_obj_file(filename)) {
+            continue;
+        }
+
+        FileState input_state;
+        if(!get_file_state(entry.path(), &input_state) || this->is_up_to_date(filename, input_state)) {
+            continue;
+        }
+
+        // skip files whose output is strictly newer than the input; equal
+        // timestamps are treated as stale on coarse-grained file systems
+        FileState output_state;
+        if(get_file_state(this->get_output_path(filename), &output_state) &&
+           output_state.mtime_ns > input_state.mtime_ns) {
+            this->converted[filename] = input_state;
+            continue;
+        }
+
+        const auto now = clock::now();
+        this->pending.emplace(filename, PendingJob{now, now});
+    }
+}
+
+void MeshWatcher::process_pending() {
+    const auto now = clock::now();
+    for(auto it = this->pending.begin(); it != this->pending.end(); ) {
+        // the stop signals are blocked here; leave the remaining jobs for
+        // later so that shutdown waits for at most one conversion
+        if(is_stop_pending()) {
+            return;
+        }
+
+        if(now - it->second.last_event >= std::chrono::milliseconds(this->debounce_ms)) {
+            this->convert(it->first, it->second.first_event);
+            it = this->pending.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void MeshWatcher::convert(const std::string& filename, const clock::time_point& first_event) {
+    const boost::filesystem::path input = this->input_dir / filename;
+
+    // take the fingerprint before reading, so that a save during the
+    // conversion is picked up again by the next event; the file may also
+    // have been removed or renamed again in the meantime
+    FileState state;
+    if(!get_file_state(input, &state)) {
+        return;
+    }
+
+    if(this->is_up_to_date(filename, state)) {
+        std::cout << "Unchanged: " << filename << std::endl;
+        return;
+    }
+
+    const boost::filesystem::path output = this->get_output_path(filename);
+    const boost::filesystem::path output_tmp = output.string() + ".tmp";
+
+    try {
+        const auto start = clock::now();
+        std::unique_ptr<MeshBase> mesh(this->parser.read_obj(input.string()));
+        const auto parsed = clock::now();
+        const unsigned int nr_vertices = mesh->get_nr_vertices();
+
+        // write to a temporary file first so that consumers never see a
+        // partially written mesh
+        this->parser.write_bz2(output_tmp.string(), mesh.get());
+        boost::filesystem::rename(output_tmp, output);
+        const auto written = clock::now();
+
+        this->converted[filename] = state;
+
+        typedef std::chrono::duration<double, std::milli> ms;
+        std::cout << boost::format("Converted %s -> %s (%i vertices): parse %.1f ms, write %.1f ms, save-to-asset %.1f ms")
+                     % filename
+                     % output.filename().string()
+                     % nr_vertices
+                     % ms(parsed - start).count()
+                     % ms(written - parsed).count()
+                     % ms(written - first_event).count()
+                  << std::endl;
+
+    } catch(const std::exception& e) {
+        // a broken file should not bring down the watcher
+        std::cerr << "Failed to convert " << filename << ": " << e.what() << std::endl;
+        boost::system::error_code ec;
+        boost::filesystem::remove(output_tmp, ec);
+    }
+}
+
+bool MeshWatcher::is_up_to_date(const std::string& filename, const FileState& state) const {
+    auto it = this->converted.find(filename);
+    return it != this->converted.end() && it->second == state;
+}
+
+bool MeshWatcher::get_file_state(const boost::filesystem::path& path, FileState* state) {
+    struct stat st;
+    if(stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) {
+        return false;
+    }
+
+    // use nanosecond timestamps where available; successive saves within
+    // the same second are common
+#if defined(__linux__)
+    state->mtime_ns = (int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+#elif defined(_APPLE)
+    state->mtime_ns = (int64_t)st.st_mtimespec.tv_sec * 1000000000 + st.st_mtimespec.tv_nsec;
+#else
+    state->mtime_ns = (int64_t)st.st_mtime * 1000000000;
+#endif
+    state->size = st.st_size;
+
+    return true;
+}
+
+boost::filesystem::path MeshWatcher::get_output_path(const std::string& filename) const {
+    return this->output_dir / boost::filesystem::path(filename).stem().concat(".mesh");
+}
+
+bool MeshWatcher::is_obj_file(const std::string& filename) {
+    return boost::algorithm::iends_with(filename, ".obj");
+}
+
+bool MeshWatcher::is_stop_pending() {
+#ifdef __linux__
+    sigset_t waiting;
+    if(sigpending(&waiting) == 0 &&
+       (sigismember(&waiting, SIGINT) == 1 || sigismember(&waiting, SIGTERM) == 1)) {
+        return true;
+    }
+#endif
+    return stop_requested;
+}
+
+void MeshWatcher::handle_signal(int) {
+    stop_requested = 1;
+}
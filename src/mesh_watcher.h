@@ -0,0 +1,112 @@
+/**************************************************************************
+ *   mesh_watcher.h  --  This file is part of OBJ2BIT.                    *
+ *                                                                        *
+ *   Copyright (C) 2017, Ivo Filot (ivo@ivofilot.nl)                      *
+ *                                                                        *
+ *   OBJ2BIT is free software:                                            *
+ *   you can redistribute it and/or modify it under the terms of the      *
+ *   GNU General Public License as published by the Free Software         *
+ *   Foundation, either version 3 of the License, or (at your option)     *
+ *   any later version.                                                   *
+ *                                                                        *
+ *   OBJ2BIT is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#ifndef _MESH_WATCHER_H
+#define _MESH_WATCHER_H
+
+#include <string>
+#include <unordered_map>
+#include <chrono>
+#include <memory>
+#include <csignal>
+
+#include <boost/filesystem.hpp>
+
+#include "mesh_parser.h"
+
+/*
+ * Keeps a single converter alive and watches a directory for modified
+ * OBJ files. Rapid successive saves of the same file are coalesced: a
+ * file is only converted once no new write has been seen for
+ * `debounce_ms` milliseconds. Conversion is skipped when the input did
+ * not change since the last conversion (same mtime and size).
+ */
+class MeshWatcher {
+private:
+    typedef std::chrono::steady_clock clock;
+
+    // a file for which a write was seen but which is not yet converted
+    struct PendingJob {
+        clock::time_point first_event;  // first save since last conversion
+        clock::time_point last_event;   // most recent save
+    };
+
+    // fingerprint of an input file at the moment it was converted
+    struct FileState {
+        int64_t mtime_ns;
+        int64_t size;
+
+        bool operator==(const FileState& rhs) const {
+            return this->mtime_ns == rhs.mtime_ns && this->size == rhs.size;
+        }
+    };
+
+    boost::filesystem::path input_dir;
+    boost::filesystem::path output_dir;
+    unsigned int debounce_ms;
+
+    MeshParser parser;  // reused for every job
+
+    std::unordered_map<std::string, PendingJob> pending;
+    std::unordered_map<std::string, FileState> converted;
+
+    static volatile std::sig_atomic_t stop_requested;
+
+public:
+    MeshWatcher(const std::string& _input_dir,
+                const std::string& _output_dir,
+                unsigned int _debounce_ms);
+
+    /*
+     * Convert all out-of-date files and keep converting on change until
+     * SIGINT or SIGTERM is received
+     */
+    void run();
+
+private:
+    /*
+     * Find all OBJ files whose output is missing or out of date and queue
+     * them as pending jobs
+     */
+    void scan();
+
+    void process_pending();
+
+    void convert(const std::string& filename, const clock::time_point& first_event);
+
+    bool is_up_to_date(const std::string& filename, const FileState& state) const;
+
+    static bool get_file_state(const boost::filesystem::path& path, FileState* state);
+
+    boost::filesystem::path get_output_path(const std::string& filename) const;
+
+    static bool is_obj_file(const std::string& filename);
+
+    /*
+     * Whether SIGINT or SIGTERM has been received, including while it is
+     * still blocked
+     */
+    static bool is_stop_pending();
+
+    static void handle_signal(int signum);
+};
+
+#endif //_MESH_WATCHER_H
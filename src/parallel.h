@@ -0,0 +1,107 @@
+/**************************************************************************
+ *   parallel.h  --  This file is part of OBJ2BIT.                        *
+ *                                                                        *
+ *   Copyright (C) 2017, Ivo Filot (ivo@ivofilot.nl)                      *
+ *                                                                        *
+ *   OBJ2BIT is free software:                                            *
+ *   you can redistribute it and/or modify it under the terms of the      *
+ *   GNU General Public License as published by the Free Software         *
+ *   Foundation, either version 3 of the License, or (at your option)     *
+ *   any later version.                                                   *
+ *                                                                        *
+ *   OBJ2BIT is distributed in the hope that it will be useful,           *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty          *
+ *   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *   See the GNU General Public License for more details.                 *
+ *                                                                        *
+ *   You should have received a copy of the GNU General Public License    *
+ *   along with this program.  If not, see http://www.gnu.org/licenses/.  *
+ *                                                                        *
+ **************************************************************************/
+
+#ifndef _PARALLEL_H
+#define _PARALLEL_H
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+// return the number of threads to use when zero (i.e. "auto") is requested
+inline unsigned int get_nr_threads(unsigned int nr_threads) {
+    if(nr_threads == 0) {
+        nr_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    return nr_threads;
+}
+
+/*
+ * Split the range [0, n) in contiguous blocks and call func(thread_id, begin, end)
+ * for every block on its own thread
+ */
+template<typename Func>
+void parallel_for(size_t n, unsigned int nr_threads, Func func) {
+    nr_threads = (unsigned int)std::min<size_t>(get_nr_threads(nr_threads), std::max<size_t>(n, 1));
+
+    if(nr_threads == 1) {
+        func(0u, (size_t)0, n);
+        return;
+    }
+
+    std::vector<std::thread> threads;
+    threads.reserve(nr_threads);
+    for(unsigned int i=0; i<nr_threads; i++) {
+        const size_t begin = n * i / nr_threads;
+        const size_t end = n * (i + 1) / nr_threads;
+        threads.emplace_back(func, i, begin, end);
+    }
+
+    for(auto& thread : threads) {
+        thread.join();
+    }
+}
+
+/*
+ * Sort blocks concurrently and merge neighbouring blocks pairwise until a
+ * single sorted range remains
+ */
+template<typename Iterator, typename Compare>
+void parallel_sort(Iterator first, Iterator last, Compare comp, unsigned int nr_threads) {
+    const size_t n = std::distance(first, last);
+    nr_threads = get_nr_threads(nr_threads);
+
+    if(nr_threads == 1 || n < 65536) {
+        std::sort(first, last, comp);
+        return;
+    }
+
+    std::vector<size_t> bounds(nr_threads + 1);
+    for(unsigned int i=0; i<=nr_threads; i++) {
+        bounds[i] = n * i / nr_threads;
+    }
+
+    parallel_for(nr_threads, nr_threads, [&](unsigned int, size_t begin, size_t end) {
+        for(size_t i=begin; i<end; i++) {
+            std::sort(first + bounds[i], first + bounds[i+1], comp);
+        }
+    });
+
+    while(bounds.size() > 2) {
+        const size_t nr_merges = (bounds.size() - 1) / 2;
+        parallel_for(nr_merges, nr_threads, [&](unsigned int, size_t begin, size_t end) {
+            for(size_t i=begin; i<end; i++) {
+                std::inplace_merge(first + bounds[2*i], first + bounds[2*i+1], first + bounds[2*i+2], comp);
+            }
+        });
+
+        std::vector<size_t> merged;
+        for(size_t i=0; i<bounds.size(); i+=2) {
+            merged.push_back(bounds[i]);
+        }
+        if(merged.back() != n) {
+            merged.push_back(n);
+        }
+        bounds.swap(merged);
+    }
+}
+
+#endif //_PARALLEL_H